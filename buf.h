@@ -1,30 +1,67 @@
 #ifndef BUF_H
 #define BUF_H
 
+#include <atomic>
+#include <mutex>
+#include <condition_variable>
+#include <thread>
+#include <vector>
+#include <deque>
+#include <chrono>
+#include <string>
 #include "db.h"
+#include "bufPolicy.h"
+#include "bufTrace.h"
+#include "wal.h"
 // define if debug output wanted
 // #define DEBUGBUF
 
 // declarations for buffer pool hash table
 struct hashBucket
 {
-  File *file;       // pointer a file object (more on this below)
+  const File *file; // pointer a file object (more on this below); NULL if slot is empty
   int pageNo;       // page number within a file
   int frameNo;      // frame number of page in the buffer pool
-  hashBucket *next; // next node in the hash table
 };
 
-// hash table to keep track of pages in the buffer pool
+// one independently latched piece of the hash table: a flat,
+// open-addressed array of buckets probed linearly
+struct alignas(64) hashPartition
+{
+  std::mutex latch; // protects everything below
+  int size;         // number of buckets, a power of two
+  int count;        // number of buckets in use
+  hashBucket *ht;   // actual hash table
+};
+
+// hash table to keep track of pages in the buffer pool.
+// The table is split into HTLATCHES partitions, each with its own latch
+// and its own open-addressed bucket array, so that threads working on
+// different pages do not serialize on one mutex. The arrays are sized
+// from the number of buffers up front, so in steady state insert and
+// remove never allocate. insert/lookup/remove do not lock anything
+// themselves: the caller must hold latch(file,pageNo) for the entry it
+// is working on.
 class BufHashTbl
 {
 private:
-  int HTSIZE;
-  hashBucket **ht;                              // actual hash table
-  int hash(const File *file, const int pageNo); // returns value between 0 and HTSIZE-1
+  static const int HTLATCHBITS = 6;
+  static const int HTLATCHES = 1 << HTLATCHBITS; // number of partitions
+  hashPartition parts[HTLATCHES];
+
+  static unsigned long hash(const File *file, const int pageNo); // mixes key into 64 bits
+  hashPartition &partition(const unsigned long h)
+  {
+    return parts[h >> (64 - HTLATCHBITS)];
+  }
+  bool grow(hashPartition &part); // double the size of a partition
 
 public:
-  BufHashTbl(const int htSize); // constructor
-  ~BufHashTbl();                // destructor
+  BufHashTbl(const int bufs); // constructor, sized for bufs entries
+  ~BufHashTbl();              // destructor
+
+  // returns the latch protecting the partition (file,pageNo) hashes to
+  std::mutex &latch(const File *file, const int pageNo);
 
   // insert entry into hash table mapping (file,pageNo) to frameNo;
   // returns 0 if OK, HASHTBLERROR if an error occurred
@@ -42,29 +79,71 @@ public:
 
 class BufMgr; // forward declaration of BufMgr class
 
-// class for maintaining information about buffer pool frames
-class BufDesc
+// how BufMgr allocates its buffer pool; flags may be or'ed together
+enum PoolFlags
+{
+  POOL_HUGEPAGES = 1, // back the pool with 1GB or 2MB pages if the system has them
+  POOL_INTERLEAVE = 2 // spread the pool's pages over all NUMA nodes
+};
+
+// class for maintaining information about buffer pool frames.
+// All state is atomic so that eviction can inspect frames
+// without a global lock. A thread owns a frame exclusively once it
+// has moved pinCnt from 0 to 1 on a frame that is not in the hash
+// table; file and pageNo are only changed by such an owner. How
+// recently a frame was used is kept by the replacement policy.
+// version moves on whenever the frame goes from unpinned to pinned,
+// which is the only way to get at page or descriptor to change them,
+// so an unpinned frame whose version did not move has not changed;
+// that is what optimistic reads check (see BufMgr::startRead()).
+// Descriptors are kept apart from the pages, two to a cache line, so
+// that scans over them never touch page data. A descriptor of all zero
+// bytes is an empty, unpinned frame, which lets BufMgr map bufTable as
+// fresh zero memory rather than construct every entry.
+class alignas(32) BufDesc
 {
   friend class BufMgr;
+  friend class BufPolicy;
 
 private:
-  File *file;  // pointer to file object
-  int pageNo;  // page within file
-  int frameNo; // frame # of frame
-  int pinCnt;  // number of times this page has been pinned
-  bool dirty;  // true if dirty;  false otherwise
-  bool valid;  // true if page is valid
-  bool refbit; // has this buffer frame been reference recently
+  std::atomic<File *> file;   // pointer to file object
+  std::atomic<int> pageNo;    // page within file
+  int frameNo;                // frame # of frame
+  std::atomic<int> pinCnt;    // number of times this page has been pinned
+  std::atomic<bool> dirty;    // true if dirty;  false otherwise
+  std::atomic<bool> valid;    // true if page is valid
+  std::atomic<bool> ioPending; // true while the page is being read from disk
+  std::atomic<bool> inRing;   // page was read with a hint into a ring frame
+  std::atomic<unsigned int> version; // bumped on every first pin or claim
 
   void Clear()
   { // initialize buffer frame for a new user
-    pinCnt = 0;
     file = NULL;
     pageNo = -1;
     dirty = false;
     valid = false;
+    ioPending = false;
+    inRing = false;
+    pinCnt = 0; // last: releases the frame to other threads
   };
 
+  // try to take exclusive ownership of an unpinned frame
+  bool tryClaim()
+  {
+    int expected = 0;
+    if (!pinCnt.compare_exchange_strong(expected, 1))
+      return false;
+    version++;
+    return true;
+  }
+
+  // pin a frame the caller found in the hash table under its latch
+  void pin()
+  {
+    if (pinCnt++ == 0)
+      version++;
+  }
+
   void Set(File *filePtr, int pageNum)
   {
     file = filePtr;
@@ -72,24 +151,66 @@ private:
     pinCnt = 1;
     dirty = false;
     valid = true;
-    refbit = true;
+    inRing = false;
   }
 
-  BufDesc()
+  BufDesc() : version(0)
   {
     Clear();
   }
 };
 
+// how a caller of readPage() is going to use the page
+enum AccessHint
+{
+  ACCESS_NORMAL,     // may be used again, counts as a reference
+  ACCESS_SEQUENTIAL, // part of a scan; read ahead, but keep out of the way
+  ACCESS_ONESHOT     // used once, no read-ahead either
+};
+
+// counters kept by BufMgr; see BufStats for what they count
+enum BufStat
+{
+  STAT_ACCESSES,
+  STAT_HITS,
+  STAT_MISSES,
+  STAT_READS,
+  STAT_WRITES,
+  STAT_ALLOCS,
+  STAT_VICTIMSTEPS,
+  STAT_EVICTIONS,
+  STAT_DIRTYEVICTIONS,
+  STAT_ALLOCFAILS,
+  NUMSTATS
+};
+
 struct BufStats
 {
-  int accesses;   // Total number of accesses to buffer pool
-  int diskreads;  // Number of pages read from disk (including allocs)
-  int diskwrites; // Number of pages written back to disk
+  unsigned long accesses;       // Total number of accesses to buffer pool
+  unsigned long hits;           // Number of accesses that found the page in the pool
+  unsigned long misses;         // Number of readPage()s that had to read the page
+  unsigned long diskreads;      // Number of pages read from disk (including allocs)
+  unsigned long diskwrites;     // Number of pages written back to disk
+  unsigned long allocs;         // Number of frames allocated by allocBuf()
+  unsigned long victimSteps;    // Frames the policy looked at to find victims
+  unsigned long evictions;      // Number of pages evicted to free a frame
+  unsigned long dirtyEvictions; // Evicted pages that had to be written first
+  unsigned long allocFails;     // Number of allocBuf() calls returning BUFFEREXCEEDED
 
   void clear()
   {
-    accesses = diskreads = diskwrites = 0;
+    accesses = hits = misses = diskreads = diskwrites = 0;
+    allocs = victimSteps = evictions = dirtyEvictions = allocFails = 0;
+  }
+
+  double hitRate() const // fraction of accesses that were hits
+  {
+    return accesses > 0 ? (double)hits / accesses : 0.0;
+  }
+
+  double stepsPerAlloc() const // average victimSteps per allocated frame
+  {
+    return allocs > 0 ? (double)victimSteps / allocs : 0.0;
   }
 
   BufStats()
@@ -98,43 +219,407 @@ struct BufStats
   }
 };
 
+// a page read handed to the read-ahead threads. The frame is already
+// in the hash table with ioPending set and is pinned by the request.
+struct ioRequest
+{
+  File *file;  // file to read from
+  int pageNo;  // page to read
+  int frameNo; // frame to read it into
+};
+
+// read-ahead state for one sequential stream of readPage calls
+struct seqStream
+{
+  std::mutex latch;  // protects the fields below
+  const File *file;  // file the stream is reading
+  int nextPage;      // page number that continues the stream
+  int run;           // number of consecutive pages read so far
+  int readAhead;     // highest page number already prefetched
+
+  seqStream() : file(NULL), nextPage(-1), run(0), readAhead(0) {}
+};
+
+// a recorded call, as kept in memory until dumpTrace() writes it out
+struct traceEntry
+{
+  unsigned long timestamp; // nanoseconds on the monotonic clock
+  const File *file;        // file of the page
+  int pageNo;              // page number within the file
+  unsigned char op;        // a TraceOp
+  unsigned char flags;     // TRACE_HIT, TRACE_DIRTY
+};
+
+// The trace records of one thread. Only that thread appends, and only
+// dumpTrace() (under traceLatch) takes records out, so the ring needs
+// no lock: each side publishes its position with a release store.
+struct traceRing
+{
+  std::thread::id owner;           // thread that records here
+  unsigned short thread;           // number of that thread within the trace
+  std::atomic<unsigned long> head; // records appended so far
+  std::atomic<unsigned long> tail; // records taken out so far
+  traceEntry *entries;             // TRACERING records, indexed modulo
+};
+
+// What BufMgr::startRead() saw of a page at the start of an optimistic
+// read, for endRead() to check. A stamp that was used for a page before
+// remembers its frame, which spares the hash table lookup the next time.
+struct ReadStamp
+{
+  const File *file;  // file of the page, NULL if the stamp is unused
+  int pageNo;        // page number within the file
+  int frameNo;       // frame the page was found in
+  unsigned int version; // version of the frame when the read started
+
+  ReadStamp() : file(NULL), pageNo(-1), frameNo(-1), version(0) {}
+};
+
+// A page pinned in the buffer pool. Handles are filled in by the
+// PageHandle versions of BufMgr::readPage() and allocPage() and unpin
+// their page when released, reassigned or destroyed, which needs no
+// hash table lookup since the handle knows the frame. Handles can be
+// moved but not copied; one handle must not be used by two threads.
+class PageHandle
+{
+  friend class BufMgr;
+
+private:
+  BufMgr *mgr;   // buffer manager the page is pinned in, NULL if empty
+  File *file;    // file of the page
+  int pageNo;    // page number within the file
+  int frameNo;   // frame holding the page, -1 for a mapped file
+  Page *page;    // the page itself
+  bool dirty;    // unpin the page dirty
+
+  void attach(BufMgr *bufMgr, File *filePtr, const int pageNum,
+              const int frame, Page *pagePtr);
+
+public:
+  PageHandle() : mgr(NULL), file(NULL), pageNo(-1), frameNo(-1),
+                 page(NULL), dirty(false) {}
+  PageHandle(PageHandle &&other);
+  PageHandle &operator=(PageHandle &&other);
+  PageHandle(const PageHandle &) = delete;
+  PageHandle &operator=(const PageHandle &) = delete;
+  ~PageHandle()
+  {
+    release();
+  }
+
+  Page *get() const { return page; }          // the page, NULL if empty
+  Page *operator->() const { return page; }
+  int getPageNo() const { return pageNo; }
+  bool empty() const { return mgr == NULL; }   // true if no page is held
+  void markDirty() { dirty = true; }           // page was modified
+  const Status release();                       // unpin the page now
+};
+
+// Buffer manager. All public methods may be called concurrently from
+// several threads. Page contents are not latched: callers that modify
+// a pinned page must coordinate among themselves.
+// Files opened with FILE_MMAP bypass the pool: readPage() and
+// allocPage() return pointers into the file's mapping, and the pins
+// are counted by the File. The hash table and the replacement policy
+// only ever see pages of regular files.
 class BufMgr
 {
+  friend class PageHandle;
+
 private:
-  unsigned int clockHand;
-  int numBufs;           // Number of pages in buffer pool
+  std::atomic<int> numBufs; // Number of pages in buffer pool
+  int maxBufs;           // most frames the pool can grow to
   BufHashTbl *hashTable; // hash table mapping (File, page) to frame
   BufDesc *bufTable;     // vector of status info, 1 per page
-  BufStats bufStats;     // buffer pool statistics
+  size_t poolBytes;      // size of the mapping holding bufPool
+  size_t poolPage;       // size of the pages backing bufPool
+  size_t tableBytes;     // size of the mapping holding bufTable
+  std::atomic<int> freshFrames; // frames below this have been handed out
+  int usedFrames() const // frames that can hold a page or be pinned
+  {
+    int n = freshFrames, bufs = numBufs;
+    return n < bufs ? n : bufs;
+  }
 
-  const Status allocBuf(int &frame); // allocate a free frame.
-  const void releaseBuf(int frame);  // return unused frame to end of list
-  void advanceClock()
+  // resizing. Frames from numBufs up to retiredEnd were emptied by a
+  // shrink and stay claimed, so that nothing can take them until the
+  // pool grows again.
+  static const int RESIZEWAIT = 100; // ms to wait for a frame to be unpinned
+  std::mutex resizeLatch;            // serializes resize()
+  int retiredEnd;
+  const Status retireFrame(const int frame); // empty a frame for shrinking
+  void growTo(const int bufs);
+  bool poolHuge;         // bufPool is backed by explicit huge pages
+  BufPolicy *policy;     // picks the frames allocBuf() evicts
+
+  // buffer pool statistics, see BufStats. Threads are spread over
+  // STATSLOTS cache-line sized slots so that they do not all update one
+  // counter; getBufStats() adds the slots up.
+  static const int STATSLOTS = 16;
+  struct alignas(64) statSlot
   {
-    clockHand = (clockHand + 1) % numBufs;
+    std::atomic<unsigned long> counts[NUMSTATS];
+  };
+  statSlot statSlots[STATSLOTS];
+  static int threadSlot(); // slot of the calling thread
+
+  // one in this many good optimistic reads of a thread is passed on to
+  // the policy as a reference, see endRead()
+  static const unsigned int TOUCHSAMPLE = 8;
+  void count(const BufStat which, const unsigned long n = 1)
+  {
+    statSlots[threadSlot()].counts[which].fetch_add(n, std::memory_order_relaxed);
+  }
+
+  std::mutex ioLatch;              // protects waits on ioPending and ioInFlight
+  std::condition_variable ioDone;  // signalled when a page read completes
+
+  // read-ahead: pages are read by a small pool of I/O threads
+  static const int IOTHREADS = 4;   // number of read-ahead threads
+  static const int SEQSTREAMS = 16; // number of tracked sequential streams
+  static const int SEQTRIGGER = 4;  // consecutive pages that start read-ahead
+  static const int READAHEAD = 16;  // pages read ahead of a sequential stream
+  std::deque<ioRequest> ioQueue;    // reads waiting for an I/O thread
+  std::vector<std::thread> ioThreads;
+  std::mutex queueLatch;            // protects ioQueue, ioThreads and ioStop
+  std::condition_variable queueReady;
+  bool ioStop;                      // tells the I/O threads to exit
+  std::atomic<int> ioInFlight;      // queued or running read-ahead requests
+  seqStream streams[SEQSTREAMS];
+
+  // frames recycled for pages read with a SEQUENTIAL or ONE_SHOT hint
+  static const int RINGFRAMES = 32; // ring size, at most a quarter of the pool
+  std::atomic<int> *ring;           // frame of each slot, -1 if none yet
+  int ringSize;
+  std::atomic<unsigned int> ringNext; // slot to use next
+
+  // trace recorder, see startTrace()
+  static const int TRACERING = 1 << 15; // records per thread ring
+  std::atomic<bool> tracing;            // true while calls are recorded
+  unsigned long traceId;                // tells this pool from others to recording threads
+  std::vector<traceRing *> traceRings;  // one per thread that recorded
+  std::mutex traceLatch;                // protects traceRings, serializes dumps
+  std::atomic<unsigned long> traceDrops; // records lost to full rings
+  traceRing *traceRingOf();             // ring of the calling thread
+  void record(const TraceOp op, const File *file, const int pageNo,
+              const unsigned char flags);
+  void trace(const TraceOp op, const File *file, const int pageNo,
+             const unsigned char flags) // record a call if tracing
+  {
+    if (tracing.load(std::memory_order_relaxed))
+      record(op, file, pageNo, flags);
   }
 
+  // warm-up: the resident set saved at shutdown and read back later
+  static const int WARMBATCH = 32;      // pages per batched warm-up read
+  std::mutex warmLatch;                 // protects the fields below
+  string warmFile;                      // list saved by ~BufMgr, "" if none
+  std::deque<std::pair<string, int>> warmDropped; // pages flushFile() dropped
+  std::thread warmer;                   // background warm-up, if running
+  std::atomic<bool> warmStop;           // tells the warm-up thread to quit
+  void warmLoad(std::vector<std::pair<File *, int>> pages); // read a warm-up list
+  void stopWarmup();
+
+  // background cleaner: writes back dirty unpinned frames the policy
+  // will evict next so that allocBuf() mostly finds clean victims
+  static const int CLEANBATCH = 32;   // frames written per batch
+  static const int CLEANERTICK = 50;  // ms between cleaner passes
+  std::atomic<int> numDirty;          // number of frames with dirty set
+  std::atomic<int> lowMark;           // cleaner stops below this many dirty frames
+  std::atomic<int> highMark;          // cleaner cleans the whole pool above this
+  double lowWater, highWater;         // the watermarks as fractions of the pool
+  std::atomic<bool> cleanerOn;        // true while the cleaner thread runs
+  std::thread cleaner;
+  std::mutex cleanerLatch;            // protects cleanerStop, waits on cleanerWake
+  std::condition_variable cleanerWake;
+  bool cleanerStop;                   // tells the cleaner thread to exit
+  std::mutex cleanLatch;              // held while the cleaner writes a batch
+
+  void setDirty(BufDesc *frameState) // set dirty, keeping numDirty right
+  {
+    if (!frameState->dirty.exchange(true))
+      numDirty++;
+  }
+  bool takeDirty(BufDesc *frameState) // clear dirty, returns old value
+  {
+    if (!frameState->dirty.exchange(false))
+      return false;
+    numDirty--;
+    return true;
+  }
+
+  // write-ahead logging, see setLog()
+  LogMgr *logMgr;                        // log dirty pages wait for, NULL if none
+  std::atomic<unsigned long> *frameLsns; // LSN of the last change logged in each frame
+  const Status logAhead(const int *frames, const int n); // flush the log for frames
+
+  const Status allocBuf(int &frame, const bool freshOnly = false); // allocate a free frame.
+  const Status allocRing(int &frame); // allocate a frame from the ring
+  const Status loadPages(File *file, const int *pageNos, const int n,
+                         Page **pages, const bool freshOnly); // readPages() body
+  const Status evictFrame(const int frame, bool &taken); // empty a claimed frame
+  const Status unPinFrame(const int frameNo, const bool dirty); // unpin by frame
+  void referenced(const int frame) // a normal reference to a pinned frame
+  {
+    if (bufTable[frame].inRing)
+      bufTable[frame].inRing = false; // somebody wants it after all
+    policy->hit(frame);
+  }
+  const void releaseBuf(int frame);  // return an unused claimed frame
+  const Status waitForIO(BufDesc *frameState); // wait until a frame is loaded
+  void finishIO(BufDesc *frameState);          // wake threads waiting on a frame
+  void failRead(File *file, const int pageNo, const int frame); // undo a failed load
+  void drainIO();                              // wait for all read-ahead to finish
+  void ioWorker();                             // body of a read-ahead thread
+  void detectSequential(File *file, const int pageNo,
+                        const AccessHint hint); // trigger read-ahead
+  void cleanerMain();                          // body of the cleaner thread
+  void cleanAhead(const int window, const int target); // write back next victims
+  void writeBatch(int *frames, const int n);   // write claimed dirty frames
+  void sortFrames(int *frames, const int n);   // order frames by file, page
+  const Status writeRuns(const int *frames, const int n); // coalesced write-back
+
 public:
   Page *bufPool; // actual buffer pool
 
-  BufMgr(const int bufs);
+  // A pool of bufs frames that can grow to maxBufs (0 means bufs);
+  // address space for maxBufs frames is reserved up front.
+  BufMgr(const int bufs, const PolicyKind kind = POLICY_CLOCK,
+         const int poolFlags = POOL_HUGEPAGES, const int maxBufs = 0);
   ~BufMgr();
 
-  const Status readPage(File *file, const int PageNo, Page *&page);
+  // pins a page, reading it in if needed. The hint says how the page
+  // will be used; see AccessHint.
+  const Status readPage(File *file, const int PageNo, Page *&page,
+                        const AccessHint hint = ACCESS_NORMAL);
+  // start reading count pages from firstPage into the pool in the
+  // background. Only a hint: pages that do not fit are skipped.
+  const Status prefetch(File *file, const int firstPage, const int count,
+                        const AccessHint hint = ACCESS_NORMAL);
   const Status unPinPage(File *file, const int PageNo, const bool dirty);
   const Status allocPage(File *file, int &PageNo, Page *&page);
   // allocates a new, empty page
+  // pin or unpin n pages of a file at once; reads of the pages not in
+  // the pool are batched. Either all pages are pinned or none.
+  const Status readPages(File *file, const int *pageNos, const int n,
+                         Page **pages);
+  const Status unPinPages(File *file, const int *pageNos, const int n,
+                          const bool dirty);
+  // the same as readPage() and allocPage(), returning the page in a
+  // handle that unpins it
+  const Status readPage(File *file, const int PageNo, PageHandle &handle,
+                        const AccessHint hint = ACCESS_NORMAL);
+  const Status allocPage(File *file, int &PageNo, PageHandle &handle);
+
+  // Optimistic reads, for short read-only looks at a page without the
+  // cost of a pin. startRead() hands out the page unpinned; the caller
+  // copies what it needs and then asks endRead() whether the copy is
+  // good. If not, the page was changed, evicted or pinned meanwhile:
+  // the copy is to be thrown away and the read retried, or done with
+  // readPage() instead. Nothing read from the page may be relied on,
+  // not even as an offset into it, before endRead() says so.
+  // A page pinned by anyone counts as being changed. startRead()
+  // returns HASHNOTFOUND if the page is not in the pool or belongs to a
+  // mapped file, and PAGEPINNED while it is pinned. Reading a page
+  // again with the stamp of the last read takes no latch at all.
+  // A good read is counted as an access and a hit in the stats slot of
+  // its thread, a cache line that no other thread writes unless there
+  // are more than STATSLOTS threads. Only one in TOUCHSAMPLE good reads
+  // of a thread tells the policy, whose reference bits and counts all
+  // threads share: a page that is only read optimistically looks
+  // colder to the policy than it is, but a hot one is still kept.
+  const Status startRead(File *file, const int PageNo, const Page *&page,
+                         ReadStamp &stamp);
+  bool endRead(const ReadStamp &stamp);
   const Status flushFile(const File *file);               // writing out all dirty pages of the file
+
+  // Write-ahead logging. With a log set, a dirty page goes to disk only
+  // once the log is durable up to the LSN of the last change logged for
+  // it, so a change is durable as soon as the log is flushed past it
+  // and pages can be written back whenever eviction or the cleaner get
+  // to them. Changes are logged with logUpdate() while the page is
+  // pinned, before it is unpinned. The log is set before the pool is
+  // used and must outlive it.
+  void setLog(LogMgr *log)
+  {
+    logMgr = log;
+  }
+  // Logs bytes [offset, offset + length) of a pinned page as they are
+  // now and stamps the page with the LSN of the record, also returned
+  // in lsn. The page may be a Page or a PaxPage, which keep the LSN in
+  // the same place (see wal.h). Returns BADBUFFER if the pool has no log or the page is not
+  // in one of its frames, as the pages of mapped files are not.
+  const Status logUpdate(File *file, const int PageNo, Page *page,
+                         const int offset, const int length,
+                         unsigned long &lsn);
   const Status disposePage(File *file, const int PageNo); // dispose of page in file
   void printSelf();
 
-  const BufStats &getBufStats() const // get buffer pool usage
+  // Background cleaner. Once more than highWater of the pool is dirty,
+  // dirty unpinned pages are written back until at most lowWater is;
+  // between the two only the frames the policy would evict soonest are
+  // cleaned. Watermarks are fractions of the pool size.
+  void startCleaner(const double lowWater = 0.1, const double highWater = 0.3);
+  void stopCleaner();
+  void setDirtyWatermarks(const double lowWater, const double highWater);
+  int getDirtyCount() const // number of dirty pages in the pool
+  {
+    return numDirty;
+  }
+
+  // Grows or shrinks the pool to bufs frames while it is in use.
+  // Shrinking writes back and drops the pages in the frames at the end
+  // of the table; if one of them stays pinned, the pool only shrinks
+  // that far and PAGEPINNED is returned.
+  const Status resize(const int bufs);
+  int getNumBufs() const // current number of frames
+  {
+    return numBufs;
+  }
+  int getMaxBufs() const // most frames resize() can grow to
+  {
+    return maxBufs;
+  }
+
+  bool hugePages() const // true if the pool got explicit huge pages
   {
-    return bufStats;
+    return poolHuge;
   }
-  const void clearBufStats()
+
+  const char *policyName() const // name of the replacement policy
+  {
+    return policy->name();
+  }
+
+  BufStats getBufStats() const; // get buffer pool usage
+  const void clearBufStats();
+
+  // Warm-up. With a warm-up file set, the pool writes the list of pages
+  // it holds to that file when it is destroyed, counting the pages that
+  // flushFile() dropped meanwhile, so that closing the files first does
+  // not lose them. saveWarmup() writes such a list at any time.
+  // warmup() reads the pages of a list that belong to the given open
+  // files back in, sorted and in batches, and only into frames that were
+  // never used, so it never evicts anything. In the background, the
+  // files must stay open until waitWarmup() returns.
+  void setWarmupFile(const string &fileName);
+  const Status saveWarmup(const string &fileName);
+  const Status warmup(const string &fileName, File *const *files, const int n,
+                      const bool background = true);
+  void waitWarmup();
+
+  // Trace recording. While on, every readPage(), allocPage(), unPinPage()
+  // and disposePage() call is recorded into a ring of the calling
+  // thread. A full ring drops records rather than wait, so dump often
+  // enough; getTraceDrops() says how many were lost. dumpTrace() writes
+  // the records so far to a file in the format of bufTrace.h, in
+  // timestamp order, and forgets them.
+  void startTrace();
+  void stopTrace();
+  const Status dumpTrace(const string &fileName);
+  unsigned long getTraceDrops() const
   {
-    bufStats.clear();
+    return traceDrops;
   }
 };
 
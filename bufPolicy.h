@@ -0,0 +1,261 @@
+#ifndef BUFPOLICY_H
+#define BUFPOLICY_H
+
+#include <atomic>
+#include <mutex>
+#include <vector>
+#include <list>
+#include <set>
+#include <tuple>
+#include <unordered_map>
+#include "db.h"
+
+// replacement policies a BufMgr can be constructed with
+enum PolicyKind
+{
+  POLICY_CLOCK,  // one reference bit per frame
+  POLICY_GCLOCK, // clock with a small usage count per frame
+  POLICY_LRU2,   // evict the page whose second-last reference is oldest
+  POLICY_2Q      // new pages wait in a FIFO before they join an LRU list
+};
+
+class BufDesc; // forward declaration, defined in buf.h
+
+// Decides which frame allocBuf() evicts next. The buffer manager tells
+// the policy about every page that is put into, referenced in or taken
+// out of a frame, and asks it for victims. Calls about one frame never
+// overlap (the caller has the frame pinned or claimed), but calls about
+// different frames may, so every policy does its own locking.
+// victim() only proposes a frame: the caller still has to claim it and
+// asks again if that fails.
+class BufPolicy
+{
+protected:
+  const BufDesc *bufTable;  // frames, looked at to pass over pinned ones
+  std::atomic<int> numBufs; // frames in use: the first numBufs of the table
+
+  bool pinned(const int frame) const;
+
+public:
+  BufPolicy(const BufDesc *table, const int bufs)
+      : bufTable(table), numBufs(bufs) {}
+  virtual ~BufPolicy() {}
+
+  // returns a new policy of the given kind for a pool of up to bufs
+  // frames, all of them in use until resize() says otherwise
+  static BufPolicy *create(const PolicyKind kind, const BufDesc *table,
+                           const int bufs);
+
+  virtual const char *name() const = 0;
+
+  // a page was put into frame. referenced is false for read-ahead: the
+  // first hit() on such a page counts as its first reference.
+  virtual void loaded(const int frame, const File *file, const int pageNo,
+                      const bool referenced) = 0;
+  // the page in frame was referenced again
+  virtual void hit(const int frame) = 0;
+  // the page in frame was read without a pin (BufMgr::startRead()).
+  // Unlike hit() this may overlap with other calls about the frame, so
+  // it is only a hint and must not take a latch; by default it is
+  // ignored.
+  virtual void touched(const int frame) {}
+  // frame no longer holds a page. evicted is false when the page was
+  // disposed of or could not be read, or the frame was handed out
+  // fresh and not used; the policy may not have seen it before.
+  virtual void removed(const int frame, const bool evicted) = 0;
+  // an unpinned frame to evict next, or -1 if every frame is pinned.
+  // steps is incremented by the number of frames looked at.
+  virtual int victim(unsigned long &steps) = 0;
+  // up to n frames in the order they are likely to be evicted, for the
+  // background cleaner; pinned frames may be among them
+  virtual void upcoming(std::vector<int> &frames, const int n) = 0;
+
+  // From now on only frames below bufs are used. limit() just makes
+  // victim() and upcoming() pass over the others, while resize() also
+  // forgets them. Frames that come back when the pool grows are
+  // announced with removed() first.
+  void limit(const int bufs)
+  {
+    numBufs = bufs;
+  }
+  virtual void resize(const int bufs)
+  {
+    numBufs = bufs;
+  }
+};
+
+// GCLOCK. A hand sweeps the frames, decrementing the usage count of
+// each one it passes and taking the first unpinned frame whose count is
+// zero. Counts saturate at maxCount. CLOCK is BitClockPolicy below.
+// No lock is taken: the hand and the counts are atomic.
+class ClockPolicy : public BufPolicy
+{
+private:
+  std::atomic<unsigned int> clockHand;
+  std::atomic<unsigned char> *usage; // usage count of each frame
+  unsigned char maxUsage;            // counts saturate here
+
+public:
+  ClockPolicy(const BufDesc *table, const int bufs, const int maxCount);
+  ~ClockPolicy();
+
+  const char *name() const { return "GCLOCK"; }
+  void loaded(const int frame, const File *file, const int pageNo,
+              const bool referenced);
+  void hit(const int frame);
+  void touched(const int frame) { hit(frame); }
+  void removed(const int frame, const bool evicted);
+  int victim(unsigned long &steps);
+  void upcoming(std::vector<int> &frames, const int n);
+};
+
+// CLOCK with the reference bits packed 64 frames to a word. The hand
+// points at a frame and looks at the rest of its word at once: one
+// atomic operation clears the bits of the frames it passes, and the
+// frames whose bits were clear are the candidates, of which only those
+// need their descriptor looked at to skip pinned ones. The hand stops
+// just after the victim, so the frames after it keep their bits until
+// the hand gets to them.
+class BitClockPolicy : public BufPolicy
+{
+private:
+  std::atomic<unsigned int> clockHand; // frame the hand looks at next
+  std::atomic<unsigned long> *refBits; // reference bit of each frame
+
+  void setBit(const int frame)
+  {
+    unsigned long bit = 1UL << (frame % 64);
+    if (!(refBits[frame / 64].load(std::memory_order_relaxed) & bit))
+      refBits[frame / 64].fetch_or(bit);
+  }
+  void clearBit(const int frame)
+  {
+    refBits[frame / 64].fetch_and(~(1UL << (frame % 64)));
+  }
+
+public:
+  BitClockPolicy(const BufDesc *table, const int bufs);
+  ~BitClockPolicy();
+
+  const char *name() const { return "CLOCK"; }
+  void loaded(const int frame, const File *file, const int pageNo,
+              const bool referenced);
+  void hit(const int frame);
+  void touched(const int frame) { hit(frame); }
+  void removed(const int frame, const bool evicted);
+  int victim(unsigned long &steps);
+  void upcoming(std::vector<int> &frames, const int n);
+};
+
+// Bounded FIFO of pages that were recently evicted, each remembered
+// with a value. Used by LRU-2 and 2Q to recognize pages that come back.
+class GhostList
+{
+private:
+  typedef std::pair<const File *, int> Key;
+  struct KeyHash
+  {
+    size_t operator()(const Key &key) const
+    {
+      return (size_t)key.first ^ ((size_t)(unsigned int)key.second * 0x9e3779b97f4a7c15UL);
+    }
+  };
+  typedef std::list<std::pair<Key, unsigned long>> Order;
+
+  Order order; // oldest entry at the back
+  std::unordered_map<Key, Order::iterator, KeyHash> index;
+  size_t limit; // most entries kept
+
+public:
+  GhostList(const size_t entries) : limit(entries) {}
+
+  // remember (file,pageNo), forgetting the oldest entry if full
+  void add(const File *file, const int pageNo, const unsigned long value);
+  // forget (file,pageNo); returns false if it was not remembered
+  bool take(const File *file, const int pageNo, unsigned long &value);
+};
+
+// LRU-2: evicts the page whose second most recent reference is the
+// oldest, so pages referenced only once (such as those of a scan) go
+// before pages that keep coming back. The time of the last reference
+// of an evicted page is remembered for a while, so that a page which is
+// read again soon afterwards has two references right away.
+class LRU2Policy : public BufPolicy
+{
+private:
+  // (second-last reference, last reference, frame); 0 means never
+  typedef std::tuple<unsigned long, unsigned long, int> Entry;
+
+  std::mutex latch;            // protects everything below
+  unsigned long now;           // logical time, bumped on each reference
+  std::set<Entry> queue;       // every frame seen so far, next victim first
+  std::vector<Entry> entries;  // each frame's entry in queue
+  std::vector<bool> armed;     // true once the page has been referenced
+  std::vector<const File *> files;
+  std::vector<int> pages;
+  GhostList history;
+
+  void requeue(const int frame, const unsigned long older,
+               const unsigned long last);
+
+public:
+  LRU2Policy(const BufDesc *table, const int bufs);
+
+  const char *name() const { return "LRU-2"; }
+  void loaded(const int frame, const File *file, const int pageNo,
+              const bool referenced);
+  void hit(const int frame);
+  void removed(const int frame, const bool evicted);
+  int victim(unsigned long &steps);
+  void upcoming(std::vector<int> &frames, const int n);
+  void resize(const int bufs);
+};
+
+// 2Q: a page read in joins the FIFO A1in. If it is evicted from there
+// without having been promoted, its identity goes to the ghost list
+// A1out; when it is read again while still in A1out it joins the LRU
+// list Am. A scan thus only ever churns A1in, which is kept at a
+// quarter of the pool while Am has pages to give.
+class TwoQPolicy : public BufPolicy
+{
+private:
+  enum Queue
+  {
+    Q_NONE, // frame not seen yet
+    Q_FREE,
+    Q_A1IN,
+    Q_AM
+  };
+
+  std::mutex latch;        // protects everything below
+  std::list<int> freeList; // frames that hold no page
+  std::list<int> a1in;     // newest page at the front
+  std::list<int> am;       // most recently used page at the front
+  std::vector<Queue> where;
+  std::vector<std::list<int>::iterator> pos; // each frame's place in its queue
+  std::vector<const File *> files;
+  std::vector<int> pages;
+  GhostList a1out;
+  size_t maxIn; // A1in above this size gives up victims first
+
+  std::list<int> &queueOf(const int frame);
+  bool usable(const int frame) const // frame may be proposed as a victim
+  {
+    return frame < numBufs && !pinned(frame);
+  }
+  int lastUnpinned(const std::list<int> &queue, unsigned long &steps) const;
+
+public:
+  TwoQPolicy(const BufDesc *table, const int bufs);
+
+  const char *name() const { return "2Q"; }
+  void loaded(const int frame, const File *file, const int pageNo,
+              const bool referenced);
+  void hit(const int frame);
+  void removed(const int frame, const bool evicted);
+  int victim(unsigned long &steps);
+  void upcoming(std::vector<int> &frames, const int n);
+  void resize(const int bufs);
+};
+
+#endif
@@ -0,0 +1,42 @@
+#ifndef BUFTRACE_H
+#define BUFTRACE_H
+
+// Page-access traces, written by the BufMgr trace recorder and replayed
+// by the bench program. A trace file is a TraceHeader followed by
+// TraceRecords, in the byte order of the machine that wrote them.
+
+const char TRACEMAGIC[8] = {'B', 'U', 'F', 'T', 'R', 'A', 'C', 'E'};
+const unsigned int TRACEVERSION = 1;
+
+// the call a record stands for
+enum TraceOp
+{
+  TRACE_READ,   // readPage()
+  TRACE_ALLOC,  // allocPage()
+  TRACE_UNPIN,  // unPinPage()
+  TRACE_DISPOSE // disposePage()
+};
+
+// bits of TraceRecord::flags
+const unsigned char TRACE_HIT = 1;   // page was in the pool already
+const unsigned char TRACE_DIRTY = 2; // page was unpinned dirty
+
+struct TraceHeader
+{
+  char magic[8];           // TRACEMAGIC
+  unsigned int version;    // TRACEVERSION
+  unsigned int recordSize; // sizeof(TraceRecord)
+};
+
+struct TraceRecord
+{
+  unsigned long timestamp; // nanoseconds on the monotonic clock
+  unsigned int fileId;     // file of the page, numbered within the trace
+  int pageNo;              // page number within the file
+  unsigned short thread;   // thread that made the call, numbered from 0
+  unsigned char op;        // a TraceOp
+  unsigned char flags;     // TRACE_HIT, TRACE_DIRTY
+  unsigned int pad;        // zero
+};
+
+#endif
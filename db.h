@@ -2,7 +2,13 @@
 #define DB_H
 
 #include <sys/types.h>
+#include <atomic>
 #include <functional>
+#include <mutex>
+#include <vector>
+#include <unordered_map>
+#include <list>
+#include <string_view>
 #include "error.h"
 #include <string.h>
 using namespace std;
@@ -15,20 +21,157 @@ using namespace std;
 // forward class definition for db
 class DB;
 
+// how DB::openFile opens the underlying Unix file
+enum FileMode
+{
+  FILE_BUFFERED, // regular I/O through the kernel page cache
+  FILE_DIRECT,   // O_DIRECT: bypass the kernel page cache
+  FILE_MMAP      // map the file; BufMgr hands out pages in the mapping
+};
+
+// address space reserved for the mapping of a FILE_MMAP file; such a
+// file cannot grow beyond this
+const size_t MMAPRESERVE = (size_t)1 << 32;
+
+// O_DIRECT needs buffers, file offsets and lengths aligned to this
+const unsigned DIRECTALIGN = 512;
+
+// structure of DB (header) page
+
+typedef struct
+{
+  int nextFree;  // page # of next page on free list
+  int firstPage; // page # of first page in file
+  int numPages;  // total # of pages in file
+  int fsm;       // page # of first free-space map page, -1 if none
+  int flags;     // DBCOMPRESSED
+  int pageSize;  // PAGESIZE of the build that created the file
+  int format;    // DBPAGEFORMAT of the build that created the file
+} DBPage;
+
+// page size of files from before DBPage::pageSize was kept
+const int DBOLDPAGESIZE = 1024;
+
+// Layout of the data pages. Bump it whenever Page changes: files from
+// before it was kept have 0 here and, like files of another format, are
+// not opened. 1 added Page::freeSlot and Page::lsn.
+const int DBPAGEFORMAT = 1;
+
+// DBPage::flags: pages other than the header page are stored deflated
+// where that saves enough, in place of the page (see File::intwrite)
+// Pages keep their place in the file: a deflated page saves disk space
+// only by the whole file system blocks it leaves free, which are
+// punched out, and reading it still reads its whole place, though the
+// punched blocks cost no I/O. Compression thus needs PAGESIZE to be at
+// least twice the file system block size; below that createFile()
+// refuses it with NOCOMPRESS.
+const int DBCOMPRESSED = 1;
+
+// Free-space map: each page of a file may be given a category from 0 to
+// FSMCATS - 1, where a page of category c had at least c / FSMCATS of a
+// page free when it was recorded. The categories are kept in map pages,
+// four bits a page, which are chained from DBPage::fsm and read and
+// written through the file's buffer pool.
+const int FSMCATS = 16;
+
+// I/O latency histogram. Bucket k counts operations that took from 2^k
+// up to 2^(k+1) - 1 nanoseconds; the last bucket also counts anything
+// slower.
+const int IOBUCKETS = 32;
+
+struct IOHistogram
+{
+  unsigned long count;              // number of operations
+  unsigned long totalNs;            // nanoseconds spent in them
+  unsigned long buckets[IOBUCKETS]; // operations per latency bucket
+
+  void clear()
+  {
+    count = totalNs = 0;
+    for (int k = 0; k < IOBUCKETS; k++)
+      buckets[k] = 0;
+  }
+
+  // upper bound in nanoseconds of the bucket holding the given fraction
+  // of operations, e.g. 0.99 for the 99th percentile; 0 if none
+  unsigned long percentile(const double fraction) const;
+
+  IOHistogram()
+  {
+    clear();
+  }
+};
+
+// the live counters of an IOHistogram. Updates are relaxed atomics, so
+// recording stays cheap enough to leave on.
+class IOTimer
+{
+private:
+  std::atomic<unsigned long> count;
+  std::atomic<unsigned long> totalNs;
+  std::atomic<unsigned long> buckets[IOBUCKETS];
+
+public:
+  IOTimer()
+  {
+    clear();
+  }
+
+  void record(const unsigned long ns);   // count one operation
+  void snapshot(IOHistogram &hist) const; // copy the counters out
+  void clear();
+};
+
+class BufMgr;
+extern BufMgr *bufMgr; // default buffer pool
+
 // class definition for open files
 class File
 {
   friend class DB;
   friend class OpenFileHashTbl;
+  friend class BufMgr;
+  friend class FdCache;
+  friend class LogMgr;
 
 public:
   Status allocatePage(int &pageNo);           // allocate a new page
+  const Status allocatePages(const int count,
+                             int *pageNos);   // allocate count new pages
   const Status disposePage(const int pageNo); // release space for a page
   const Status readPage(const int pageNo,
                         Page *pagePtr) const; // read page from file
   const Status writePage(const int pageNo,
                          const Page *pagePtr);  // write page to file
+  const Status readPages(const int firstPage, Page *const *pages,
+                         const int n) const;    // read consecutive pages
+  const Status writePages(const int firstPage, const Page *const *pages,
+                          const int n);         // write consecutive pages
   const Status getFirstPage(int &pageNo) const; // returns pageNo of first page
+  int getNumPages() const;                      // pages in the file, page 0 included
+  bool isCompressed() const                     // pages are stored deflated
+  {
+    return compressed;
+  }
+  const Status sync();                          // write back the cached header
+
+  // record in the free-space map how many bytes are free on pageNo
+  const Status setFreeSpace(const int pageNo, const int bytes);
+  // a page with at least bytes free according to the map; FILEEOF if
+  // there is none, NOSPACE if no page can have that much free
+  const Status findFreeSpace(const int bytes, int &pageNo);
+
+  // latencies of the reads and writes of this file since it was
+  // opened, or since clearIOStats()
+  void getIOStats(IOHistogram &reads, IOHistogram &writes) const;
+  void clearIOStats();
+
+  // the buffer pool the file was bound to when it was opened, else
+  // the default pool
+  BufMgr *getPool() const
+  {
+    return pool ? pool : bufMgr;
+  }
 
   bool operator==(const File &other) const
   {
@@ -36,19 +179,46 @@ public:
   }
 
 private:
-  File(const string &fname); // initialize
+  File(const string &fname, const FileMode fmode,
+       BufMgr *fpool); // initialize
   ~File();                   // deallocate file object
 
-  static const Status create(const string &fileName);
+  static const Status create(const string &fileName, const bool compress);
   static const Status destroy(const string &fileName);
 
   const Status open();
   const Status close();
 
+  // the unix file for one system call, reopened through the fd cache if
+  // it was closed there; -1 if that fails. doneFd() ends the call.
+  int useFd() const;
+  void doneFd() const
+  {
+    fdPins--;
+  }
+
   const Status intread(const int pageNo,
                        Page *pagePtr) const; // internal file read
   const Status intwrite(const int pageNo,
                         const Page *pagePtr); // internal file write
+  const Status loadFreeList();                // read the free list chain
+  const Status extend(const int count);       // add count zeroed pages
+  bool packPage(const Page *pagePtr, char *slot,
+                size_t &length) const;        // deflate a page image
+  void unpackPage(Page *pagePtr) const;       // inflate a page image read
+  const Status loadFSM();                     // read the map page chain
+  const Status mapPage(const int index, const bool create,
+                       int &mapNo);           // map page index of the chain
+
+  // FILE_MMAP files: pages are used in place and pinned here instead
+  // of in the buffer pool
+  bool isMapped() const
+  {
+    return mapBase != NULL;
+  }
+  const Status pinMapped(const int pageNo, Page *&pagePtr);
+  const Status unpinMapped(const int pageNo);
+  bool mappedPinned(const int pageNo = -1) const; // pageNo, or any if -1
 
 #ifdef DEBUGFREE
   void listFree(); // list free pages
@@ -56,11 +226,35 @@ private:
 
   string fileName; // The name of the file
   int openCnt;     // # times file has been opened
-  int unixFile;    // unix file stream for file
-};
+  mutable std::atomic<int> unixFile; // unix file, -1 while it is closed
+  mutable std::atomic<int> fdPins;   // system calls using unixFile now
+  mutable std::atomic<bool> fdUsed;  // used since the fd cache last looked
+  list<File *>::iterator fdPos;      // place in the fd cache, if fdCached
+  bool fdCached;                     // the fd cache has unixFile open
+  FileMode mode;   // how the unix file is opened
+  bool compressed; // DBCOMPRESSED is set in the header
+  int blockSize;   // block size of the file system, for punching holes
+  BufMgr *pool;    // pool the file is bound to, NULL for the default
 
-class BufMgr;
-extern BufMgr *bufMgr;
+  // The header page is read once at open and written back by sync(),
+  // which close() and BufMgr::flushFile() call.
+  mutable std::mutex headerLatch; // protects the fields below
+  DBPage header;                  // cached copy of page 0
+  bool headerDirty;               // header differs from page 0 on disk
+  vector<int> freeList;           // free list, head at the back
+  bool freeListLoaded;            // freeList mirrors the chain on disk
+
+  std::mutex fsmLatch;            // protects fsmPages and the map pages
+  vector<int> fsmPages;           // free-space map pages, in chain order
+  bool fsmLoaded;                 // fsmPages mirrors the chain on disk
+
+  char *mapBase;                  // mapping of a FILE_MMAP file, else NULL
+  mutable std::mutex mapLatch;    // protects mapPins
+  unordered_map<int, int> mapPins; // pin count of each pinned mapped page
+
+  mutable IOTimer readTimes;      // latencies of pread() and preadv() calls
+  IOTimer writeTimes;             // latencies of pwrite() and pwritev() calls
+};
 
 // declarations for hash table of open files
 struct fileHashBucket
@@ -70,28 +264,32 @@ struct fileHashBucket
   fileHashBucket *next; // next node in the hash table
 };
 
-// hash table to keep track of open files
+// hash table to keep track of open files. It doubles when it holds
+// twice as many files as it has buckets, and halves again when it
+// holds fewer than an eighth of that.
 class OpenFileHashTbl
 {
 private:
   int HTSIZE;
-  fileHashBucket **ht;       // actual hash table
-  int hash(string fileName); // returns value between 0 and HTSIZE-1
+  int count;                             // files in the table
+  fileHashBucket **ht;                   // actual hash table
+  int hash(const string_view fileName);  // returns value between 0 and HTSIZE-1
+  void rehash(const int size);           // move the files to size buckets
 
 public:
   OpenFileHashTbl();
   ~OpenFileHashTbl(); // destructor
 
   // returns OK if no error occured, HASHTBLERROR if an error occurred
-  Status insert(const string fileName, File *file);
+  Status insert(const string_view fileName, File *file);
 
   // see if fileName is already in hash table.  If so a pointer to the file
   // object is returned.
   // returns OK if found. else returns HASHNOTFOUND
-  Status find(const string fileName, File *&file);
+  Status find(const string_view fileName, File *&file);
 
   // returns OK if fileName was found.  Else return HASHTBLERROR
-  Status erase(const string fileName);
+  Status erase(const string_view fileName);
 };
 
 class DB
@@ -100,23 +298,23 @@ public:
   DB();  // initialize open file table
   ~DB(); // clean up any remaining open files
 
-  const Status createFile(const string &fileName);            // create a new file
+  const Status createFile(const string &fileName,
+                          const bool compress = false);       // create a new file
   const Status destroyFile(const string &fileName);           // destroy a file,
                                                               // release all space
-  const Status openFile(const string &fileName, File *&file); // open a file
+  const Status openFile(const string &fileName, File *&file,
+                        const FileMode mode = FILE_BUFFERED,
+                        BufMgr *pool = NULL);                 // open a file
   const Status closeFile(File *file);                         // close a file
 
+  // Open File objects keep at most fds unix files open between them;
+  // the least recently used are closed while not in use and reopened
+  // when used again. 0 sets the default, half the process's limit.
+  static void setMaxOpenFds(const int fds);
+  static int getOpenFds(); // unix files open for File objects now
+
 private:
   OpenFileHashTbl openFiles; // list of open files
 };
 
-// structure of DB (header) page
-
-typedef struct
-{
-  int nextFree;  // page # of next page on free list
-  int firstPage; // page # of first page in file
-  int numPages;  // total # of pages in file
-} DBPage;
-
 #endif
@@ -27,6 +27,7 @@ enum Status
   BADPAGEPTR,
   BADPAGENO,
   FILEEXISTS,
+  NOCOMPRESS,
 
   // BufMgr and HashTable errors
 
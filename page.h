@@ -25,17 +25,46 @@ struct slot_t
   short length; // equals -1 if slot is not in use
 };
 
-const unsigned PAGESIZE = 1024;
-const unsigned DPFIXED = sizeof(slot_t) + 4 * sizeof(short) + 2 * sizeof(int);
+// Size of a page in bytes, chosen when building with -DDBPAGESIZE=n
+// (see the makefile). Files record the size they were created with and
+// can only be opened by a build with the same size.
+#ifndef DBPAGESIZE
+#define DBPAGESIZE 1024
+#endif
+const unsigned PAGESIZE = DBPAGESIZE;
+static_assert(PAGESIZE >= 512 && PAGESIZE <= 32768 && (PAGESIZE & (PAGESIZE - 1)) == 0,
+              "page size must be a power of two that slot offsets can address");
+const unsigned DPFIXED = sizeof(slot_t) + 4 * sizeof(short) + 2 * sizeof(int) +
+                         sizeof(unsigned long);
 const unsigned PAGEDATASIZE = PAGESIZE - DPFIXED + sizeof(slot_t);
 // size of the data area of a page
 
+// Every page layout the log can be kept for (Page, PaxPage) ends in the
+// LSN of its last logged change, so the log and the buffer pool reach
+// it here without knowing which layout a frame holds (see wal.h).
+const unsigned PAGELSNOFFSET = PAGESIZE - sizeof(unsigned long);
+
+inline unsigned long getPageLSN(const void *page)
+{
+  unsigned long lsn;
+  memcpy(&lsn, (const char *)page + PAGELSNOFFSET, sizeof(lsn));
+  return lsn;
+}
+
+inline void setPageLSN(void *page, const unsigned long lsn)
+{
+  memcpy((char *)page + PAGELSNOFFSET, &lsn, sizeof(lsn));
+}
+
 // Class definition for a minirel data page.
 // The design assumes that records are kept compacted when
 // deletions are performed. Notice, however, that the slot
 // array cannot be compacted.  Notice, this class does not keep
 // the records align, relying instead on upper levels to take
 // care of non-aligned attributes
+// The free slots in the middle of the slot array are chained in
+// ascending order, so insertRecord() reuses the lowest one without
+// looking at the slots in use.
 
 class Page
 {
@@ -45,9 +74,15 @@ private:
   short slotCnt;   // number of slots in use;
   short freePtr;   // offset of first free byte in data[]
   short freeSpace; // number of bytes free in data[]
-  short dummy;     // for alignment purposes
+  short freeSlot;  // first free slot below slotCnt, -1 if none; the
+                   // offset of each free slot holds the next one
   int nextPage;    // forwards pointer
   int curPage;     // page number of current pointer
+  unsigned long lsn; // LSN of the last logged change, 0 if none (see wal.h)
+
+  bool freeSlotOk(const short s, const short after) const; // s may follow after
+  bool freeSlotsOk() const; // freeSlot heads a proper chain
+  void chainFreeSlots();    // rebuild the chain from the slot array
 
 public:
   void init(const int pageNo); // initialize a new page
@@ -56,6 +91,14 @@ public:
   const Status getNextPage(int &pageNo) const; // returns value of nextPage
   const Status setNextPage(const int pageNo);  // sets value of nextPage to pageNo
   const short getFreeSpace() const;            // returns amount of free space
+  unsigned long getLSN() const                 // LSN of the last logged change
+  {
+    return lsn;
+  }
+  void setLSN(const unsigned long pageLSN) // set by the log, see wal.h
+  {
+    lsn = pageLSN;
+  }
 
   // inserts a new record (rec) into the page, returns RID of record
   const Status insertRecord(const Record &rec, RID &rid);
@@ -73,6 +116,14 @@ public:
 
   // returns reference to record with RID rid
   const Status getRecord(const RID &rid, Record &rec);
+
+  // Fills recs, and rids unless it is NULL, with up to max records in
+  // slot order, starting at slot slotNo, which is then set to the slot
+  // to go on from. count is set to the number of records returned.
+  // returns NORECORDS if there are no records from slotNo on,
+  // INVALIDSLOTNO if slotNo is negative
+  const Status getRecords(Record *recs, RID *rids, const int max,
+                          int &count, int &slotNo);
 };
 
 #endif
@@ -0,0 +1,103 @@
+#ifndef PAXPAGE_H
+#define PAXPAGE_H
+
+#include "page.h"
+
+// types of the attributes of a PAX page
+enum PaxType
+{
+  PAX_INT,   // 4-byte int
+  PAX_FLOAT, // 4-byte float
+  PAX_CHAR   // fixed-width string of up to 255 bytes
+};
+
+// comparisons PaxPage::select() evaluates
+enum PaxOp
+{
+  PAX_LT,
+  PAX_LTE,
+  PAX_EQ,
+  PAX_GTE,
+  PAX_GT,
+  PAX_NE
+};
+
+struct PaxColumn
+{
+  PaxType type;
+  short width; // bytes of the attribute; 4 for PAX_INT and PAX_FLOAT
+};
+
+const int PAXMAXCOLS = 16;
+const unsigned PAXFIXED = 2 * sizeof(int) + 4 * sizeof(short) +
+                          PAXMAXCOLS * (1 + 2 * sizeof(short)) +
+                          sizeof(unsigned long);
+// unsigned longs a selection bitmap of a PAX page can need
+const int PAXBITWORDS = (PAGESIZE - PAXFIXED + 63) / 64;
+
+// Class definition for a PAX data page, an alternative to Page for
+// relations of fixed-width attributes. Each attribute has a minipage
+// of its own in data[] that holds its values for all records of the
+// page back to back, so a scan over one attribute reads only that
+// attribute's bytes. Records are passed in and out as rows: their
+// attribute values in column order, without padding.
+// Records are kept dense: deleting one moves the last record of the
+// page into its slot, so slot numbers are not stable over deletes.
+// A PaxPage is PAGESIZE bytes and can be used in place of a Page in a
+// buffer frame; like a Page, it ends in its LSN (see PAGELSNOFFSET).
+
+class PaxPage
+{
+private:
+  int curPage;                       // page number of current pointer
+  int nextPage;                      // forwards pointer
+  short numCols;                     // attributes per record
+  short recCnt;                      // records on the page
+  short maxRecs;                     // records the page can hold
+  short recLen;                      // bytes of a row
+  unsigned char types[PAXMAXCOLS];   // PaxType of each attribute
+  short widths[PAXMAXCOLS];          // bytes of each attribute
+  short starts[PAXMAXCOLS];          // offset of each minipage in data[]
+  char data[PAGESIZE - PAXFIXED];
+  unsigned long lsn;                 // LSN of the last logged change, see wal.h
+
+public:
+  // initialize a new page for records of the given attributes
+  // returns INVALIDRECLEN if not even one such record fits
+  const Status init(const int pageNo, const PaxColumn *cols, const int n);
+  void dumpPage() const; // dump contents of a page
+
+  const Status getNextPage(int &pageNo) const; // returns value of nextPage
+  const Status setNextPage(const int pageNo);  // sets value of nextPage to pageNo
+  int getRecCnt() const                        // records on the page
+  {
+    return recCnt;
+  }
+  int getMaxRecs() const // records the page can hold
+  {
+    return maxRecs;
+  }
+
+  // appends a record given as a row of rec.length == recLen bytes
+  const Status insertRecord(const Record &rec, RID &rid);
+
+  // delete the record with the specified rid; the last record of the
+  // page takes its slot
+  const Status deleteRecord(const RID &rid);
+
+  // copies the record with RID rid into row, recLen bytes
+  const Status getRecord(const RID &rid, char *row) const;
+
+  // copies one attribute of the record with RID rid into value
+  const Status getField(const RID &rid, const int col, void *value) const;
+
+  // Sets bit i of bits (PAXBITWORDS words) if record i satisfies
+  // "attribute col op value", and clears the others; matches is the
+  // number of bits set. value points to an int, a float, or for
+  // PAX_CHAR attributes, width bytes, which only PAX_EQ and PAX_NE take.
+  // Uses AVX2 or NEON where the machine has them.
+  const Status select(const int col, const PaxOp op, const void *value,
+                      unsigned long *bits, int &matches) const;
+};
+
+#endif
@@ -0,0 +1,79 @@
+#ifndef WAL_H
+#define WAL_H
+
+#include <atomic>
+#include <mutex>
+#include <condition_variable>
+#include <string>
+#include <vector>
+#include "db.h"
+
+// Write-ahead log. A change to a page is logged as a redo record that
+// holds the changed bytes as they are after the change; the records
+// are appended to one log file in order. Each record has an LSN, the
+// offset in the log just past it, and the page it redoes carries the
+// LSN of the last record logged for it. Every page layout that is
+// logged keeps that LSN in the last bytes of the page, at
+// PAGELSNOFFSET (getPageLSN()), as Page and PaxPage do; a page of any
+// other layout must not be logged.
+// A change is durable once the log is on disk up to its LSN, which
+// flush() sees to. The pages themselves can then go to disk whenever:
+// a buffer pool with a log (BufMgr::setLog()) writes a dirty page only
+// after the log is durable up to the page's LSN, and after a crash
+// recover() redoes the changes that did not get to disk.
+// Allocating pages and the file header are not logged.
+class LogMgr
+{
+private:
+  std::mutex latch;                   // protects everything below
+  std::condition_variable flushDone;  // signalled when a flush ends
+  int unixFile;                       // the log file, -1 while closed
+  std::vector<char> buffer;           // records not yet written
+  unsigned long bufferLsn;            // LSN the buffer starts at
+  unsigned long endLsn;               // LSN of the last record appended
+  bool flushing;                      // a thread is writing the log
+  Status failure;                     // first write error, OK if none
+  std::atomic<unsigned long> durableLsn; // the log is on disk up to here
+  std::atomic<unsigned long> syncs;      // fdatasync() calls so far
+
+public:
+  LogMgr();
+  ~LogMgr(); // closes the log
+
+  // Opens the log file, creating it if need be. A torn record at its
+  // end, from a crash while it was being written, is cut off.
+  const Status open(const string &fileName);
+  const Status close(); // flushes and closes the log
+
+  // Appends a redo record for bytes [offset, offset + length) of page
+  // pageNo of file, as they are in page now; lsn is set to the LSN of
+  // the record. The page is not stamped: BufMgr::logUpdate() does that.
+  const Status append(const File *file, const int pageNo, const Page *page,
+                      const int offset, const int length, unsigned long &lsn);
+
+  // Returns once the log is on disk up to lsn. Group commit: a caller
+  // that has to wait writes, when its turn comes, all that was appended
+  // so far, so concurrent callers share one write and one fdatasync().
+  const Status flush(const unsigned long lsn);
+
+  unsigned long getEndLsn() // LSN of the last record appended
+  {
+    std::lock_guard<std::mutex> guard(latch);
+    return endLsn;
+  }
+  unsigned long getDurableLsn() const // the log is on disk up to here
+  {
+    return durableLsn;
+  }
+  unsigned long getSyncs() const // fdatasync() calls so far
+  {
+    return syncs;
+  }
+
+  // Redo after a crash: applies every record of the log whose page on
+  // disk has an older LSN, opening the files named in the log through
+  // db. No page of those files may be in a buffer pool meanwhile.
+  const Status recover(DB &db);
+};
+
+#endif